@@ -48,6 +48,21 @@ int main(){
             data.b = 10.1;
             writer.addObj("data", data);
         }
+        {
+            spio::Table table;
+            table.addCol<int>("a");
+            table.addCol<double>("b");
+
+            for (int i = 0; i < 3; i++) {
+                Data data;
+                data.a = 10 + i;
+                data.b = 10.1 + i;
+
+                table.add(0, data.a);
+                table.add(1, data.b);
+            }
+            writer.addTbl("table", table);
+        }
 
         writer.print();
         writer.flush();
@@ -88,9 +103,20 @@ int main(){
             printInt(reader.root()->getCNode("d"));
             printData(reader.root()->getCNode("data", 0));
             printData(reader.root()->getCNode("data", 1));
+
+            {
+                const spio::Node* node = reader.root()->getCNode("table");
+                const spio::Column<int> a = node->getCol<int>("a");
+                const spio::Column<double> b = node->getCol<double>("b");
+
+                printf("%s\n", node->name().c_str());
+                for (int r = 0; r < node->elms(); r++) {
+                    printf("a %d, b %.1lf\n", a[r], b[r]);
+                }
+            }
         }
-        catch (char *str) {
-            printf(str);
+        catch (const char *str) {
+            printf("%s", str);
         }
     }
     return 0;
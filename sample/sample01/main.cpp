@@ -3,5 +3,37 @@
 
 int main(){
 
+    {
+        spio::Writer writer("test_bin.sp", spio::BIN_HEADER);
+
+        for (int i = 0; i < 3; i++) {
+            SPIO_NEST(writer, "data");
+
+            writer.addTxt("a", "%d", i);
+            writer.addBin("b", i * 0.1);
+        }
+        writer.flush();
+    }
+
+    // binary header -> text header
+    spio::convert("test_bin.sp", "test_txt.sp", spio::TXT_HEADER);
+
+    {
+        spio::Reader reader("test_bin.sp");
+        if (reader.parse() == false) {
+            printf("error %d at %lld\n", reader.error(), reader.errpos());
+            return 1;
+        }
+
+        // exception-free accessors (this sample builds with -fno-exceptions)
+        const std::vector<const spio::Node*> list = reader.root()->getCNodes("data");
+        for (int i = 0; i < (int)list.size(); i++) {
+            std::string a;
+            double b = 0.0;
+            if (list[i]->getCNode("a")->cnvTxt(a) && list[i]->getCNode("b")->cnvBin(b)) {
+                printf("a %s, b %.1lf\n", a.c_str(), b);
+            }
+        }
+    }
     return 0;
 }
\ No newline at end of file
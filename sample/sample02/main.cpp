@@ -0,0 +1,49 @@
+﻿#define SPIO_USE_PRINT 1
+#include "spio.h"
+
+int main(){
+
+    const spio::HEADER_TYPE headers[] = { spio::TXT_HEADER, spio::BIN_HEADER };
+
+    for (int h = 0; h < 2; h++) {
+        // a binary header writer only appends to a file it started
+        remove("test_log.sp");
+
+        spio::Writer writer("test_log.sp", headers[h]);
+        spio::Reader reader("test_log.sp");
+
+        for (int i = 0; i < 3; i++) {
+            // writer side: add a batch of top-level nodes and append it to the file
+            for (int j = 0; j < 2; j++) {
+                SPIO_NEST(writer, "log");
+
+                writer.addTxt("step", "%d", i * 2 + j);
+                writer.addBin("value", (i * 2 + j) * 0.5);
+            }
+            if (writer.append() == false) {
+                printf("append error\n");
+                return 1;
+            }
+
+            // reader side: parse only the nodes appended since the last refresh
+            if (reader.refresh() == false) {
+                printf("error %d at %lld\n", reader.error(), reader.errpos());
+                return 1;
+            }
+
+            const std::vector<const spio::Node*> list = reader.root()->getCNodes("log");
+            for (int k = 0; k < (int)list.size(); k++) {
+                std::string step;
+                double value = 0.0;
+                if (list[k]->getCNode("step")->cnvTxt(step) && list[k]->getCNode("value")->cnvBin(value)) {
+                    printf("step %s, value %.1lf\n", step.c_str(), value);
+                }
+            }
+
+            // drop the nodes already processed, the read position is kept
+            reader.release();
+        }
+        printf("%s: %lld bytes\n", (headers[h] == spio::BIN_HEADER) ? "binary" : "text", reader.fpos());
+    }
+    return 0;
+}
\ No newline at end of file
@@ -9,7 +9,9 @@
 #include<stdlib.h>
 #include<string.h>
 
+#include<string>
 #include<vector>
+#include<deque>
 #include<map>
 
 #ifdef _WIN32
@@ -30,12 +32,36 @@ namespace spio {
 #define SPIO_USE_PRINT 0
 #endif
 
+// 64-bit file offsets
+#ifdef _WIN32
+#define SPIO_FSEEK _fseeki64
+#define SPIO_FTELL _ftelli64
+#else
+#define SPIO_FSEEK fseeko
+#define SPIO_FTELL ftello
+#endif
+
 #if SPIO_USE_PRINT
 #define SPIO_PRINTF(...) ::printf(__VA_ARGS__);
 #else
 #define SPIO_PRINTF(...) if(0){ ::printf(__VA_ARGS__); }
 #endif
 
+// exceptions (off: throwing accessors print the error and abort, e.g. -fno-exceptions builds)
+#ifndef SPIO_USE_EXCEPTION
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define SPIO_USE_EXCEPTION 1
+#else
+#define SPIO_USE_EXCEPTION 0
+#endif
+#endif
+
+#if SPIO_USE_EXCEPTION
+#define SPIO_THROW(STR) throw STR;
+#else
+#define SPIO_THROW(STR) { ::printf("%s", STR); ::abort(); }
+#endif
+
 
     //--------------------------------------------------------------------------------
     // node type
@@ -46,6 +72,116 @@ namespace spio {
         TXT_NODE = 1,
         BIN_NODE = 2,
         OBJ_NODE = 3,
+        TBL_NODE = 4,
+    };
+
+
+    //--------------------------------------------------------------------------------
+    // header type
+    //--------------------------------------------------------------------------------
+
+    enum HEADER_TYPE {
+        TXT_HEADER = 0,
+        BIN_HEADER = 1,
+    };
+
+    //--------------------------------------------------------------------------------
+    // error code
+    //--------------------------------------------------------------------------------
+
+    enum ERROR_CODE {
+        NON_ERROR = 0,
+        FILE_ERROR = 1,
+        FORMAT_ERROR = 2,
+        SIZE_ERROR = 3,
+        NEST_ERROR = 4,
+    };
+
+    // binary header files start with this magic (text files start with a bracket)
+#define SPIO_BIN_MAGIC "\0spb"
+#define SPIO_BIN_MAGIC_SIZE 4
+
+    // binary header record that appends names to the name table
+#define SPIO_BIN_NAMES 0x10
+
+    // binary header record that skips padding bytes (payload alignment)
+#define SPIO_BIN_PAD 0x11
+
+    // stream mode writes the buffer to the file when it grows beyond this size
+#define SPIO_STREAM_SIZE (1 << 20)
+
+    // stream mode object size fields (fixed width, patched in place)
+#define SPIO_STREAM_TXT_SIZE 20
+#define SPIO_STREAM_BIN_SIZE 10
+
+
+    //--------------------------------------------------------------------------------
+    // table
+    //--------------------------------------------------------------------------------
+
+    // column offsets in a table node are aligned to this size
+#define SPIO_TBL_ALIGN 8
+
+    class Table {
+        friend class Writer;
+
+    private:
+        // column names
+        std::vector<std::string> m_names;
+
+        // column element sizes
+        std::vector<int> m_elms;
+
+        // column data
+        std::vector<std::vector<unsigned char> > m_cols;
+
+    public:
+
+        Table() {
+        }
+
+        void clear() {
+            m_names.clear();
+            m_elms.clear();
+            m_cols.clear();
+        }
+
+        // -1: the name contains ',' or '\n' (separators of the text schema)
+        template<typename TYPE>
+        int addCol(const std::string &name) {
+            if (name.find_first_of(",\n") != std::string::npos) return -1;
+
+            m_names.push_back(name);
+            m_elms.push_back((int)sizeof(TYPE));
+            m_cols.push_back(std::vector<unsigned char>());
+            return (int)m_cols.size() - 1;
+        }
+
+        // false: no such column or the type size does not match the column
+        template<typename TYPE>
+        bool add(const int c, const TYPE &data) {
+            bool ret = false;
+            if (c < 0 || c >= (int)m_cols.size() || m_elms[c] != (int)sizeof(TYPE)) return ret;
+
+            const unsigned char *p = (const unsigned char*)&data;
+            m_cols[c].insert(m_cols[c].end(), &p[0], &p[sizeof(TYPE)]);
+            ret = true;
+            return ret;
+        }
+
+        // -1: columns have different numbers of rows
+        long long rows() const {
+            long long ret = (m_cols.size() > 0) ? (long long)(m_cols[0].size() / m_elms[0]) : 0;
+            for (int c = 1; c < (int)m_cols.size(); c++) {
+                if ((long long)(m_cols[c].size() / m_elms[c]) != ret) return -1;
+            }
+            return ret;
+        }
+
+        int cols() const {
+            return (int)m_cols.size();
+        }
+
     };
 
 
@@ -53,31 +189,130 @@ namespace spio {
     // writer
     //--------------------------------------------------------------------------------
 
+    class Node;
+
     class Writer {
 
     private:
         // file path
         std::string m_path;
 
+        // header type
+        HEADER_TYPE m_header;
+
         // data buffer
         std::vector<unsigned char> m_buff;
 
         // nest stack
-        std::vector<int> m_stack;
+        std::vector<long long> m_stack;
+
+        // number of aligned payloads at each nest (buffered mode)
+        std::vector<long long> m_astack;
+
+        // number of aligned payloads written so far (buffered mode: since the last append)
+        long long m_aligned;
+
+        // name table (binary header)
+        std::map<std::string, int> m_names;
+
+        // name list (binary header)
+        std::vector<std::string> m_list;
+
+        // number of names already appended to the file (binary header)
+        int m_wnames;
+
+        // stream file (open/close)
+        FILE *m_fp;
+
+        // bytes already written to the stream file
+        // (buffered mode: file offset the buffer is laid out for)
+        long long m_fpos;
+
+        // payload alignment of BIN nodes (TBL nodes are aligned to SPIO_TBL_ALIGN at least)
+        int m_align;
+
+        // FORMAT_ERROR: a name or text the text header cannot hold was added
+        ERROR_CODE m_error;
+
+        // not copyable (owns the stream file)
+        Writer(const Writer &);
+        Writer& operator = (const Writer &);
 
     public:
 
         Writer() {
+            m_header = TXT_HEADER;
+            m_aligned = 0;
+            m_wnames = 0;
+            m_fp = NULL;
+            m_fpos = 0;
+            m_align = 0;
+            m_error = NON_ERROR;
         }
-        Writer(const std::string &path) {
-            init(path);
+        Writer(const std::string &path, const HEADER_TYPE header = TXT_HEADER) {
+            m_fp = NULL;
+            m_align = 0;
+            init(path, header);
         }
 
-        void init(const std::string &path) {
+        ~Writer() {
+            close();
+        }
+
+        void init(const std::string &path, const HEADER_TYPE header = TXT_HEADER) {
+            close();
+
             m_path = path;
+            m_header = header;
 
             m_buff.clear();
             m_stack.clear();
+            m_astack.clear();
+            m_aligned = 0;
+
+            m_names.clear();
+            m_list.clear();
+            m_wnames = 0;
+            m_fpos = 0;
+            m_error = NON_ERROR;
+        }
+
+
+        //--------------------------------------------------------------------------------
+        // stream
+        //--------------------------------------------------------------------------------
+
+        // nodes are written through to the file as they are added
+        // (object sizes are patched in place, so memory does not grow with the file)
+        bool open(const std::string &path, const HEADER_TYPE header = TXT_HEADER) {
+            init(path, header);
+
+            m_fp = fopen(m_path.c_str(), "wb");
+            if (m_fp == NULL) return false;
+
+            if (m_header == BIN_HEADER) {
+                m_buff.insert(m_buff.end(), &SPIO_BIN_MAGIC[0], &SPIO_BIN_MAGIC[SPIO_BIN_MAGIC_SIZE]);
+            }
+            return true;
+        }
+
+        bool close() {
+            bool ret = false;
+            if (m_fp == NULL) return ret;
+
+            while (m_stack.size() > 0) {
+                unnest();
+            }
+            _sync(true);
+
+            ret = (fclose(m_fp) == 0 && m_error == NON_ERROR);
+            m_fp = NULL;
+            return ret;
+        }
+
+        // align BIN/TBL payloads to this size in the file
+        void setAlign(const int align) {
+            m_align = align;
         }
 
 
@@ -86,28 +321,31 @@ namespace spio {
         //--------------------------------------------------------------------------------
 
         void addTxt(const std::string &name, const std::string &text) {
-            _addName(m_buff, name, TXT_NODE);
+            if (m_header == TXT_HEADER && text.find('\n') != std::string::npos) {
+                m_error = FORMAT_ERROR;
+            }
+
+            std::vector<unsigned char> head;
+            _addSize(head, (long long)text.size(), TXT_NODE);
+            _addHead(name, TXT_NODE, head);
 
             _addTxt(m_buff, text);
-            _addTxt(m_buff, "\n");
+            _addTail(m_buff);
+            _sync(false);
         }
 
         template<typename TYPE>
         void addTxt(const std::string &name, const std::string &format, const TYPE &data) {
-            _addName(m_buff, name, TXT_NODE);
-
-            _addTxt(m_buff, _string(format.c_str(), data));
-            _addTxt(m_buff, "\n");
+            addTxt(name, _string(format.c_str(), data));
         }
 
         template<typename TYPE>
         void addTxt(const std::string &name, const std::string &format, const TYPE *data, const int size) {
-            _addName(m_buff, name, TXT_NODE);
-
+            std::string text;
             for (int i = 0; i < size; i++) {
-                _addTxt(m_buff, _string(format.c_str(), data[i]) + ((i < size - 1) ? "," : ""));
+                text += _string(format.c_str(), data[i]) + ((i < size - 1) ? "," : "");
             }
-            _addTxt(m_buff, "\n");
+            addTxt(name, text);
         }
 
 
@@ -115,21 +353,53 @@ namespace spio {
         // binary
         //--------------------------------------------------------------------------------
 
-        void addBin(const std::string &name, const void *data, const int size) {
-            _addName(m_buff, name, BIN_NODE);
+        void addBin(const std::string &name, const void *data, const long long size) {
+            std::vector<unsigned char> head;
+            _addSize(head, size, BIN_NODE);
+            _addHead(name, BIN_NODE, head);
 
-            _addTxt(m_buff, _string("%d,", size));
-            _addBin(m_buff, data, size);
-            _addTxt(m_buff, "\n");
+            _addData(data, size);
+            _addTail(m_buff);
+            _sync(false);
         }
 
         template<typename TYPE>
         void addBin(const std::string &name, const TYPE &data) {
-            _addName(m_buff, name, BIN_NODE);
+            addBin(name, &data, (long long)sizeof(TYPE));
+        }
+
+
+        //--------------------------------------------------------------------------------
+        // table
+        //--------------------------------------------------------------------------------
+
+        // false: the columns have different numbers of rows
+        bool addTbl(const std::string &name, const Table &table) {
+            const long long rows = table.rows();
+            if (rows < 0) return false;
+
+            long long size = 0;
+            for (int c = 0; c < table.cols(); c++) {
+                size = _align(size) + rows * table.m_elms[c];
+            }
+
+            std::vector<unsigned char> head;
+            _addSchema(head, size, rows, table.m_names, table.m_elms);
+            _addHead(name, TBL_NODE, head);
 
-            _addTxt(m_buff, _string("%d,", sizeof(TYPE)));
-            _addBin(m_buff, &data, sizeof(TYPE));
-            _addTxt(m_buff, "\n");
+            long long pos = 0;
+            for (int c = 0; c < table.cols(); c++) {
+                const long long pad = _align(pos) - pos;
+                m_buff.insert(m_buff.end(), pad, 0);
+
+                if (rows > 0) {
+                    _addData(&table.m_cols[c][0], rows * table.m_elms[c]);
+                }
+                pos += pad + rows * table.m_elms[c];
+            }
+            _addTail(m_buff);
+            _sync(false);
+            return true;
         }
 
 
@@ -139,20 +409,71 @@ namespace spio {
 
         void nest(const std::string &name) {
             _addName(m_buff, name, OBJ_NODE);
-            _addTxt(m_buff, "\n");
 
-            m_stack.push_back((int)m_buff.size() - 1);
+            if (m_fp != NULL) {
+                // fixed width size field, patched by unnest
+                m_stack.push_back(_pos());
+                switch (m_header) {
+                case TXT_HEADER: _addTxt(m_buff, std::string(SPIO_STREAM_TXT_SIZE, ' ') + "\n"); break;
+                case BIN_HEADER: m_buff.insert(m_buff.end(), SPIO_STREAM_BIN_SIZE, 0); break;
+                }
+                _sync(false);
+                return;
+            }
+
+            switch (m_header) {
+            case TXT_HEADER:
+                _addTxt(m_buff, "\n");
+                m_stack.push_back((long long)m_buff.size() - 1);
+                break;
+            case BIN_HEADER:
+                m_stack.push_back((long long)m_buff.size());
+                break;
+            }
+            m_astack.push_back(m_aligned);
         }
 
         void unnest() {
-            const int size = (int)(m_buff.size() - m_stack.back());
+            if (m_fp != NULL) {
+                _patch(m_stack.back());
+                m_stack.pop_back();
+                _sync(false);
+                return;
+            }
+
+            const long long size = (long long)m_buff.size() - m_stack.back();
 
-            const std::string str = _string("%d", size - 1);
-            const std::vector<unsigned char> temp(&str[0], &str[str.size()]);
+            // the size field is inserted in front of the children,
+            // so it is padded to keep their aligned payloads aligned
+            const long long align = (m_aligned > m_astack.back()) ? _lcmAlign() : 1;
 
-            _insert(m_buff, -size, &temp[0], (int)temp.size());
+            std::vector<unsigned char> temp;
+            switch (m_header) {
+            case TXT_HEADER:
+            {
+                const std::string text = _string("%lld", size - 1);
+                _addTxt(temp, std::string((size_t)((align - (long long)text.size() % align) % align), ' ') + text);
+                break;
+            }
+            case BIN_HEADER:
+            {
+                // pad record at the head of the children
+                std::vector<unsigned char> pad;
+                for (long long p = 0; ; p++) {
+                    pad.clear();
+                    _addPadRecord(pad, p, (int)align);
+                    if ((_varLen(size + pad.size()) + (long long)pad.size()) % align == 0) break;
+                }
+                _addVar(temp, size + pad.size());
+                temp.insert(temp.end(), pad.begin(), pad.end());
+                break;
+            }
+            }
+
+            _insert(m_buff, -size, &temp[0], (long long)temp.size());
 
             m_stack.pop_back();
+            m_astack.pop_back();
         }
 
 
@@ -168,17 +489,99 @@ namespace spio {
         }
 
 
+        //--------------------------------------------------------------------------------
+        // node (copy of a parsed node and its children)
+        //--------------------------------------------------------------------------------
+
+        void addNode(const Node *node);
+
+
         //--------------------------------------------------------------------------------
         // file
         //--------------------------------------------------------------------------------
 
+        // false without writing when error() is set (buffered mode)
         bool flush() {
             bool ret = false;
 
+            if (m_fp != NULL) {
+                _sync(true);
+                return fflush(m_fp) == 0 && m_error == NON_ERROR;
+            }
+            if (m_error != NON_ERROR) return ret;
+
             FILE *fp = fopen(m_path.c_str(), "wb");
             if (fp != NULL) {
-                fwrite(&m_buff[0], 1, m_buff.size(), fp);
+                if (m_header == BIN_HEADER) {
+                    std::vector<unsigned char> head(&SPIO_BIN_MAGIC[0], &SPIO_BIN_MAGIC[SPIO_BIN_MAGIC_SIZE]);
+                    _addNames(head, 0);
+                    _addPad(head, 0);
+                    fwrite(&head[0], 1, head.size(), fp);
+                }
+                if (m_buff.size() > 0) {
+                    fwrite(&m_buff[0], 1, m_buff.size(), fp);
+                }
+                fclose(fp);
+                ret = true;
+            }
+            return ret;
+        }
+
+
+        // append buffered top-level nodes to the file and clear the buffer
+        // (for files that grow while readers follow them with Reader::refresh,
+        //  binary header: false for a file this writer did not start, its name ids would clash,
+        //  text header: false when aligned payloads are buffered and the file does not end where they were laid out)
+        bool append() {
+            bool ret = false;
+            if (m_stack.size() > 0 || m_error != NON_ERROR) return ret;
+
+            if (m_fp != NULL) {
+                return flush();
+            }
+
+            FILE *fp = fopen(m_path.c_str(), "ab");
+            if (fp != NULL) {
+                SPIO_FSEEK(fp, 0, SEEK_END);
+                long long fsize = (long long)SPIO_FTELL(fp);
+
+                if (m_header == BIN_HEADER && fsize != m_fpos) {
+                    fclose(fp);
+                    return ret;
+                }
+                if (m_header == TXT_HEADER && m_aligned > 0 && (fsize - m_fpos) % _lcmAlign() != 0) {
+                    fclose(fp);
+                    return ret;
+                }
+
+                if (m_header == BIN_HEADER) {
+                    std::vector<unsigned char> head;
+
+                    if (fsize == 0) {
+                        head.insert(head.end(), &SPIO_BIN_MAGIC[0], &SPIO_BIN_MAGIC[SPIO_BIN_MAGIC_SIZE]);
+                        m_wnames = 0;
+                    }
+                    if (m_wnames < (int)m_list.size()) {
+                        _addNames(head, m_wnames);
+                        m_wnames = (int)m_list.size();
+                    }
+                    if (m_buff.size() > 0) {
+                        _addPad(head, fsize);
+                    }
+                    if (head.size() > 0) {
+                        fwrite(&head[0], 1, head.size(), fp);
+                    }
+                    fsize += (long long)head.size();
+                }
+                if (m_buff.size() > 0) {
+                    fwrite(&m_buff[0], 1, m_buff.size(), fp);
+                }
                 fclose(fp);
+
+                // the next nodes are laid out for the end of the file
+                m_fpos = fsize + (long long)m_buff.size();
+                m_buff.clear();
+                m_aligned = 0;
                 ret = true;
             }
             return ret;
@@ -189,8 +592,14 @@ namespace spio {
         // util
         //--------------------------------------------------------------------------------
 
+        // FORMAT_ERROR: a node the text header cannot hold was added
+        // (a name with brackets or '\n', text with '\n', a column name with ',' or '\n')
+        const ERROR_CODE& error() const {
+            return m_error;
+        }
+
         void print() {
-            for (int i = 0; i < m_buff.size(); i++) {
+            for (size_t i = 0; i < m_buff.size(); i++) {
                 const char *c = (const char *)&m_buff[i];
                 SPIO_PRINTF("%c", *c);
             }
@@ -210,10 +619,9 @@ namespace spio {
             return std::string(str);
         }
 
-        void _insert(std::vector<unsigned char> &buff, const int offset, const void *data, const int size) {
+        void _insert(std::vector<unsigned char> &buff, const long long offset, const void *data, const long long size) {
             const unsigned char *d = (const unsigned char*)data;
-            const std::vector<unsigned char> temp(&d[0], &d[size]);
-            buff.insert(buff.end() + offset, temp.begin(), temp.end());
+            buff.insert(buff.end() + offset, &d[0], &d[size]);
         }
 
         template<typename TYPE>
@@ -221,22 +629,268 @@ namespace spio {
             _insert(buff, 0, &data, sizeof(TYPE));
         }
 
-        void _addBin(std::vector<unsigned char> &buff, const void *data, const int size) {
+        void _addBin(std::vector<unsigned char> &buff, const void *data, const long long size) {
             _insert(buff, 0, data, size);
         }
 
         void _addTxt(std::vector<unsigned char> &buff, const std::string &text) {
-            _insert(buff, 0, text.c_str(), (int)text.size());
+            _insert(buff, 0, text.c_str(), (long long)text.size());
+        }
+
+        // LEB128 varint (padded with continuation bytes up to width)
+        void _addVar(std::vector<unsigned char> &buff, unsigned long long val, const int width = 0) {
+            for (int i = 1; val >= 0x80 || i < width; i++) {
+                buff.push_back((unsigned char)((val & 0x7F) | 0x80));
+                val >>= 7;
+            }
+            buff.push_back((unsigned char)val);
+        }
+
+        int _varLen(unsigned long long val) {
+            int ret = 1;
+            for (; val >= 0x80; val >>= 7) ret++;
+            return ret;
+        }
+
+        long long _pos() {
+            return m_fpos + (long long)m_buff.size();
+        }
+
+        void _sync(const bool force) {
+            if (m_fp == NULL) return;
+
+            if (m_buff.size() > 0 && (force || m_buff.size() >= SPIO_STREAM_SIZE)) {
+                fwrite(&m_buff[0], 1, m_buff.size(), m_fp);
+                m_fpos += (long long)m_buff.size();
+                m_buff.clear();
+            }
+        }
+
+        // payload bytes (large payloads bypass the buffer in stream mode)
+        void _addData(const void *data, const long long size) {
+            if (m_fp != NULL && size >= SPIO_STREAM_SIZE) {
+                _sync(true);
+                fwrite(data, 1, (size_t)size, m_fp);
+                m_fpos += size;
+            }
+            else {
+                _addBin(m_buff, data, size);
+            }
+        }
+
+        // write the size of a finished object into its fixed width field (stream mode)
+        void _patch(const long long field) {
+            std::vector<unsigned char> temp;
+            switch (m_header) {
+            case TXT_HEADER:
+            {
+                const long long size = _pos() - (field + SPIO_STREAM_TXT_SIZE + 1);
+                _addTxt(temp, _string("%20lld", size));
+                break;
+            }
+            case BIN_HEADER:
+            {
+                const long long size = _pos() - (field + SPIO_STREAM_BIN_SIZE);
+                _addVar(temp, size, SPIO_STREAM_BIN_SIZE);
+                break;
+            }
+            }
+
+            if (field >= m_fpos) {
+                memcpy(&m_buff[field - m_fpos], &temp[0], temp.size());
+            }
+            else {
+                SPIO_FSEEK(m_fp, field, SEEK_SET);
+                fwrite(&temp[0], 1, temp.size(), m_fp);
+                SPIO_FSEEK(m_fp, 0, SEEK_END);
+            }
+        }
+
+        // node header (name + head), padded so that BIN/TBL payloads are aligned in the file
+        void _addHead(const std::string &name, const NODE_TYPE &type, const std::vector<unsigned char> &head) {
+            std::vector<unsigned char> temp;
+            _addName(temp, name, type);
+
+            int align = (type == BIN_NODE || type == TBL_NODE) ? m_align : 0;
+            if (type == TBL_NODE && (align < SPIO_TBL_ALIGN || align % SPIO_TBL_ALIGN != 0)) {
+                align = SPIO_TBL_ALIGN;
+            }
+
+            long long pad = 0;
+            if (align > 1) {
+                pad = (align - (_pos() + (long long)(temp.size() + head.size())) % align) % align;
+                m_aligned++;
+            }
+
+            switch (m_header) {
+            case TXT_HEADER:
+            {
+                // size fields are parsed with leading spaces skipped
+                _addBin(m_buff, &temp[0], (long long)temp.size());
+                m_buff.insert(m_buff.end(), (size_t)pad, ' ');
+                break;
+            }
+            case BIN_HEADER:
+            {
+                _addPadRecord(m_buff, pad, align);
+                _addBin(m_buff, &temp[0], (long long)temp.size());
+                break;
+            }
+            }
+            if (head.size() > 0) {
+                _addBin(m_buff, &head[0], (long long)head.size());
+            }
+        }
+
+        // pad record of pad bytes (grown by align when pad is too short for a record)
+        void _addPadRecord(std::vector<unsigned char> &buff, const long long pad, const int align) {
+            if (pad <= 0) return;
+
+            // pad record: kind, varint n, n bytes
+            for (long long len = (pad == 1) ? pad + align : pad; ; len += align) {
+                long long num = -1;
+                for (int v = 1; v < 10; v++) {
+                    if (len - 1 - v >= 0 && _varLen(len - 1 - v) == v) {
+                        num = len - 1 - v;
+                        break;
+                    }
+                }
+                if (num < 0) continue;
+
+                buff.push_back(SPIO_BIN_PAD);
+                _addVar(buff, num);
+                buff.insert(buff.end(), (size_t)num, 0);
+                break;
+            }
+        }
+
+        // common multiple of the BIN and TBL payload alignments
+        long long _lcmAlign() {
+            long long ret = SPIO_TBL_ALIGN;
+            if (m_align > 1) {
+                long long a = ret, b = m_align;
+                while (b > 0) {
+                    const long long t = a % b;
+                    a = b;
+                    b = t;
+                }
+                ret = ret / a * m_align;
+            }
+            return ret;
+        }
+
+        // pad a binary file head written at offset so that the buffer lands where it was laid out (m_fpos)
+        void _addPad(std::vector<unsigned char> &head, const long long offset) {
+            const long long align = _lcmAlign();
+
+            const long long pos = offset + (long long)head.size();
+            const long long pad = ((m_fpos - pos) % align + align) % align;
+            _addPadRecord(head, pad, (int)align);
+        }
+
+        long long _align(const long long pos) {
+            return (pos + SPIO_TBL_ALIGN - 1) / SPIO_TBL_ALIGN * SPIO_TBL_ALIGN;
+        }
+
+        int _nameId(const std::string &name) {
+            std::map<std::string, int>::iterator it = m_names.find(name);
+            if (it != m_names.end()) {
+                return it->second;
+            }
+            const int id = (int)m_list.size();
+            m_names[name] = id;
+            m_list.push_back(name);
+            return id;
+        }
+
+        void _addNames(std::vector<unsigned char> &buff, const int begin) {
+            buff.push_back(SPIO_BIN_NAMES);
+            _addVar(buff, m_list.size() - begin);
+            for (int i = begin; i < (int)m_list.size(); i++) {
+                _addVar(buff, m_list[i].size());
+                _addTxt(buff, m_list[i]);
+            }
         }
 
         void _addName(std::vector<unsigned char> &buff, const std::string &name, const NODE_TYPE &type) {
-            for (int i = 0; i < m_stack.size(); i++) {
-                _addTxt(buff, " ");
+            switch (m_header) {
+            case TXT_HEADER:
+            {
+                if (name.find_first_of("()[]{}<>\n") != std::string::npos) {
+                    m_error = FORMAT_ERROR;
+                }
+                for (int i = 0; i < m_stack.size(); i++) {
+                    _addTxt(buff, " ");
+                }
+                switch (type) {
+                case TXT_NODE: _addTxt(buff, "(" + name + ")"); break;
+                case BIN_NODE: _addTxt(buff, "{" + name + "}"); break;
+                case OBJ_NODE: _addTxt(buff, "[" + name + "]"); break;
+                case TBL_NODE: _addTxt(buff, "<" + name + ">"); break;
+                default: break;
+                }
+                break;
+            }
+            case BIN_HEADER:
+            {
+                const int id = _nameId(name);
+
+                // stream mode defines new names just before their first use
+                if (m_fp != NULL && m_wnames < (int)m_list.size()) {
+                    _addNames(buff, m_wnames);
+                    m_wnames = (int)m_list.size();
+                }
+
+                buff.push_back((unsigned char)type);
+                _addVar(buff, id);
+                _addVar(buff, m_stack.size());
+                break;
+            }
+            }
+        }
+
+        void _addSize(std::vector<unsigned char> &buff, const long long size, const NODE_TYPE &type) {
+            switch (m_header) {
+            case TXT_HEADER:
+                if (type == BIN_NODE) _addTxt(buff, _string("%lld,", size));
+                break;
+            case BIN_HEADER:
+                _addVar(buff, size);
+                break;
+            }
+        }
+
+        void _addSchema(std::vector<unsigned char> &buff, const long long size, const long long rows, const std::vector<std::string> &names, const std::vector<int> &elms) {
+            switch (m_header) {
+            case TXT_HEADER:
+            {
+                std::string schema = _string("%lld,", size) + _string("%lld", rows);
+                for (int c = 0; c < (int)names.size(); c++) {
+                    if (names[c].find_first_of(",\n") != std::string::npos) {
+                        m_error = FORMAT_ERROR;
+                    }
+                    schema += "," + names[c] + ":" + _string("%d", elms[c]);
+                }
+                _addTxt(buff, schema + "\n");
+                break;
+            }
+            case BIN_HEADER:
+            {
+                _addVar(buff, size);
+                _addVar(buff, rows);
+                _addVar(buff, names.size());
+                for (int c = 0; c < (int)names.size(); c++) {
+                    _addVar(buff, _nameId(names[c]));
+                    _addVar(buff, elms[c]);
+                }
+                break;
             }
-            switch (type) {
-            case TXT_NODE: _addTxt(buff, "(" + name + ")"); break;
-            case BIN_NODE: _addTxt(buff, "{" + name + "}"); break;
-            case OBJ_NODE: _addTxt(buff, "[" + name + "]"); break;
+            }
+        }
+
+        void _addTail(std::vector<unsigned char> &buff) {
+            if (m_header == TXT_HEADER) {
+                _addTxt(buff, "\n");
             }
         }
 
@@ -268,35 +922,97 @@ namespace spio {
 
 
     //--------------------------------------------------------------------------------
-    // node
+    // column (typed view of a table column, aligned to SPIO_TBL_ALIGN by Writer)
     //--------------------------------------------------------------------------------
 
-    class Node {
-        friend class Reader;
+    template<typename TYPE>
+    class Column {
 
     private:
-
-        // node name
-        std::string m_name;
-
-        // node type
-        NODE_TYPE m_type;
-
-        // data size
-        int m_size;
-
         // data pointer
-        void *m_ptr;
+        const TYPE *m_ptr;
 
-        // child nodes
-        std::vector<const Node*> m_cnodes;
+        // number of rows
+        long long m_size;
 
     public:
 
-        Node() {
-            m_type = NON_NODE;
+        Column() {
+            m_ptr = NULL;
+            m_size = 0;
+        }
+
+        Column(const TYPE *ptr, const long long size) {
+            m_ptr = ptr;
+            m_size = size;
+        }
+
+        const TYPE& operator [] (const long long i) const {
+            return m_ptr[i];
+        }
+
+        const TYPE* ptr() const {
+            return m_ptr;
+        }
+
+        long long size() const {
+            return m_size;
+        }
+
+        const TYPE* begin() const {
+            return m_ptr;
+        }
+
+        const TYPE* end() const {
+            return m_ptr + m_size;
+        }
+    };
+
+
+    //--------------------------------------------------------------------------------
+    // node
+    //--------------------------------------------------------------------------------
+
+    class Node {
+        friend class Reader;
+        friend class Writer;
+
+    private:
+
+        // node name
+        std::string m_name;
+
+        // node type
+        NODE_TYPE m_type;
+
+        // data size
+        long long m_size;
+
+        // data pointer
+        void *m_ptr;
+
+        // child nodes
+        std::vector<const Node*> m_cnodes;
+
+        // table rows
+        long long m_rows;
+
+        // table column names
+        std::vector<std::string> m_cnames;
+
+        // table column element sizes
+        std::vector<int> m_celms;
+
+        // table column offsets
+        std::vector<long long> m_coffs;
+
+    public:
+
+        Node() {
+            m_type = NON_NODE;
             m_size = 0;
             m_ptr = NULL;
+            m_rows = 0;
         }
 
         Node(const Node &node) {
@@ -309,6 +1025,10 @@ namespace spio {
             m_size = node.m_size;
             m_ptr = node.m_ptr;
             m_cnodes = node.m_cnodes;
+            m_rows = node.m_rows;
+            m_cnames = node.m_cnames;
+            m_celms = node.m_celms;
+            m_coffs = node.m_coffs;
             return *this;
         }
 
@@ -355,22 +1075,42 @@ namespace spio {
 
         const std::string getTxt(const int p = 0) const {
             std::string ret;
-            if (_cnvTxt(ret, p) == false) {
-                throw "spio:convert error\n";
+            if (cnvTxt(ret, p) == false) {
+                SPIO_THROW("spio:convert error\n");
             }
             return ret;
         }
 
         template<typename TYPE>
-        const TYPE getBin(const int p = 0) const {
+        const TYPE getBin(const long long p = 0) const {
             TYPE ret;
-            if (_cnvBin<TYPE>(ret, p) == false) {
-                throw "spio:convert error\n";
+            if (cnvBin<TYPE>(ret, p) == false) {
+                SPIO_THROW("spio:convert error\n");
             }
             return ret;
         }
 
-        bool _cnvTxt(std::string &dst, int p = 0) const {
+        template<typename TYPE>
+        const Column<TYPE> getCol(const int c) const {
+            Column<TYPE> ret;
+            if (cnvCol<TYPE>(ret, c) == false) {
+                SPIO_THROW("spio:convert error\n");
+            }
+            return ret;
+        }
+
+        template<typename TYPE>
+        const Column<TYPE> getCol(const std::string &name) const {
+            Column<TYPE> ret;
+            if (cnvCol<TYPE>(ret, _findCol(name)) == false) {
+                SPIO_THROW("spio:convert error\n");
+            }
+            return ret;
+        }
+
+        // exception-free accessors (false: wrong type or out of range)
+
+        bool cnvTxt(std::string &dst, int p = 0) const {
             bool ret = false;
             if (m_type != TXT_NODE) return ret;
 
@@ -383,34 +1123,75 @@ namespace spio {
         }
 
         template<typename TYPE>
-        bool _cnvBin(TYPE &dst, const int p = 0) const {
+        bool cnvBin(TYPE &dst, const long long p = 0) const {
             bool ret = false;
             if (m_type != BIN_NODE) return ret;
 
-            const std::vector<TYPE> list = _divBin<TYPE>(m_ptr, m_size);
-            if (p < list.size()) {
-                dst = list[p];
+            if (p >= 0 && p < m_size / (long long)sizeof(TYPE)) {
+                // binary payloads are aligned only with Writer::setAlign
+                memcpy(&dst, (const unsigned char*)m_ptr + p * (long long)sizeof(TYPE), sizeof(TYPE));
                 ret = true;
             }
             return ret;
         }
 
+        template<typename TYPE>
+        bool cnvCol(Column<TYPE> &dst, const int c) const {
+            bool ret = false;
+            if (m_type != TBL_NODE) return ret;
+
+            if (c >= 0 && c < (int)m_celms.size() && m_celms[c] == (int)sizeof(TYPE)) {
+                const unsigned char *p = (const unsigned char*)m_ptr + m_coffs[c];
+
+                // a typed view needs an aligned column (false for a file appended off alignment)
+                if ((size_t)p % alignof(TYPE) != 0) return ret;
+
+                dst = Column<TYPE>((const TYPE*)p, m_rows);
+                ret = true;
+            }
+            return ret;
+        }
+
+        // former names of cnvTxt/cnvBin
+        bool _cnvTxt(std::string &dst, int p = 0) const {
+            return cnvTxt(dst, p);
+        }
+
+        template<typename TYPE>
+        bool _cnvBin(TYPE &dst, const long long p = 0) const {
+            return cnvBin<TYPE>(dst, p);
+        }
+
 
         //--------------------------------------------------------------------------------
         // util
         //--------------------------------------------------------------------------------
 
-        const int elms() const {
-            int ret = 0;
+        const long long elms() const {
+            long long ret = 0;
             switch (m_type) {
-            case TXT_NODE: ret = (int)_divTxt(m_ptr, m_size).size(); break;
+            case TXT_NODE: ret = (long long)_divTxt(m_ptr, m_size).size(); break;
             case BIN_NODE: ret = m_size; break;
-            case OBJ_NODE: ret = (int)m_cnodes.size(); break;
+            case OBJ_NODE: ret = (long long)m_cnodes.size(); break;
+            case TBL_NODE: ret = m_rows; break;
             default: break;
             }
             return ret;
         }
 
+        const int cols() const {
+            return (int)m_cnames.size();
+        }
+
+        const std::string& colName(const int c) const {
+            return m_cnames[c];
+        }
+
+        // element size of a column [bytes]
+        int colElm(const int c) const {
+            return m_celms[c];
+        }
+
         const NODE_TYPE& type() const {
             return m_type;
         }
@@ -419,9 +1200,25 @@ namespace spio {
             return m_name;
         }
 
+        // data pointer and size (text, binary or table payload, object content)
+        const void* ptr() const {
+            return m_ptr;
+        }
+
+        const long long size() const {
+            return m_size;
+        }
+
     private:
 
-        std::vector<std::string> _divTxt(const void *ptr, const int size) const {
+        int _findCol(const std::string &name) const {
+            for (int c = 0; c < (int)m_cnames.size(); c++) {
+                if (m_cnames[c] == name) return c;
+            }
+            return -1;
+        }
+
+        std::vector<std::string> _divTxt(const void *ptr, const long long size) const {
             std::vector<std::string> ret;
             if (size == 0) return ret;
 
@@ -429,9 +1226,9 @@ namespace spio {
             std::string src(&p[0], &p[size]);
 
             char tok = ',';
-            int s = 0;
-            int e = (int)src.find_first_of(tok);
-            e = (e > 0) ? e : (int)src.size();
+            size_t s = 0;
+            size_t e = src.find_first_of(tok);
+            e = (e != std::string::npos && e > 0) ? e : src.size();
 
             while (s < src.size()) {
                 std::string sub(src, s, e - s);
@@ -439,27 +1236,60 @@ namespace spio {
                 ret.push_back(sub);
 
                 s = e + 1;
-                e = (int)src.find_first_of(tok, s);
+                e = src.find_first_of(tok, s);
 
                 if (e == std::string::npos) {
-                    e = (int)src.size();
+                    e = src.size();
                 }
             }
             return ret;
         }
 
-        template<typename TYPE>
-        std::vector<TYPE> _divBin(const void *ptr, const int size) const {
-            std::vector<TYPE> ret;
+    };
+
 
-            const TYPE *p = (const TYPE*)ptr;
-            for (int i = 0; i < size / sizeof(TYPE); i++) {
-                ret.push_back(p[i]);
+    inline void Writer::addNode(const Node *node) {
+        switch (node->m_type) {
+        case TXT_NODE:
+        {
+            addTxt(node->m_name, std::string((const char*)node->m_ptr, node->m_size));
+            break;
+        }
+        case BIN_NODE:
+        {
+            addBin(node->m_name, node->m_ptr, node->m_size);
+            break;
+        }
+        case TBL_NODE:
+        {
+            std::vector<unsigned char> head;
+            _addSchema(head, node->m_size, node->m_rows, node->m_cnames, node->m_celms);
+            _addHead(node->m_name, TBL_NODE, head);
+
+            _addData(node->m_ptr, node->m_size);
+            _addTail(m_buff);
+            _sync(false);
+            break;
+        }
+        case OBJ_NODE:
+        {
+            nest(node->m_name);
+            for (int i = 0; i < (int)node->m_cnodes.size(); i++) {
+                addNode(node->m_cnodes[i]);
             }
-            return ret;
+            unnest();
+            break;
         }
-
-    };
+        default:
+        {
+            // root node
+            for (int i = 0; i < (int)node->m_cnodes.size(); i++) {
+                addNode(node->m_cnodes[i]);
+            }
+            break;
+        }
+        }
+    }
 
 
     //--------------------------------------------------------------------------------
@@ -472,14 +1302,34 @@ namespace spio {
         // file path
         std::string m_path;
 
+        // header type
+        HEADER_TYPE m_header;
+
         // data buffer
         std::vector<unsigned char> m_buff;
 
-        std::vector<Node> m_cnodes;
+        // data buffers of previous refresh (nodes keep pointers into them)
+        std::deque<std::vector<unsigned char> > m_buffs;
+
+        // parsed file size
+        long long m_fpos;
+
+        // name table (binary header)
+        std::vector<std::string> m_names;
+
+        std::deque<Node> m_cnodes;
+
+        // error of the last parse/refresh and its file offset
+        ERROR_CODE m_error;
+        long long m_epos;
 
     public:
 
         Reader() {
+            m_header = TXT_HEADER;
+            m_fpos = 0;
+            m_error = NON_ERROR;
+            m_epos = -1;
         }
 
         Reader(const std::string &path) {
@@ -488,8 +1338,14 @@ namespace spio {
 
         void init(const std::string &path) {
             m_path = path;
+            m_header = TXT_HEADER;
             m_buff.clear();
+            m_buffs.clear();
+            m_fpos = 0;
+            m_names.clear();
             m_cnodes.clear();
+            m_error = NON_ERROR;
+            m_epos = -1;
         }
 
 
@@ -497,31 +1353,107 @@ namespace spio {
         // file
         //--------------------------------------------------------------------------------
 
+        // validates the whole structure once, then tokenizes without bounds checks
+        // (on a format error returns false, see error() and errpos())
         bool parse() {
             bool ret = false;
 
-            FILE *fp = fopen(m_path.c_str(), "rb");
-            if (fp != NULL) {
-                {
-                    size_t size = 0;
-                    fseek(fp, 0L, SEEK_END);
-                    size = (size_t)ftell(fp);
-                    fseek(fp, 0L, SEEK_SET);
+            init(m_path);
+
+            long long rest = 0;
+            if (_read(m_buff, 0, -1, rest) == false) {
+                m_error = FILE_ERROR;
+                return ret;
+            }
+
+            if (m_buff.size() > 0) {
+                m_header = _isBin(m_buff) ? BIN_HEADER : TXT_HEADER;
+
+                const long long begin = (m_header == BIN_HEADER) ? SPIO_BIN_MAGIC_SIZE : 0;
+
+                long long size = 0;
+                if (_check(m_buff, begin, 0, false, size) != NON_ERROR) return ret;
+
+                m_cnodes.push_back(Node());
+
+                ret = _parse(begin);
+                m_fpos = (long long)m_buff.size();
+            }
+
+            return ret;
+        }
+
+        // parse only the bytes appended since the last parse/refresh
+        // (complete top-level nodes are attached to root, a partly written tail is left for the next call,
+        //  limit > 0 reads about limit bytes at most, more only when one top-level node is larger,
+        //  partial = false: the file is complete, a partly written tail is a SIZE_ERROR)
+        bool refresh(const long long limit = -1, const bool partial = true) {
+            bool ret = false;
+
+            m_error = NON_ERROR;
+            m_epos = -1;
+
+            std::vector<unsigned char> buff;
 
-                    m_buff.resize(size);
+            // the chunk keeps the file offset modulo SPIO_TBL_ALIGN, so aligned payloads stay aligned in memory
+            const long long skip = m_fpos % SPIO_TBL_ALIGN;
+
+            long long begin = 0;
+            long long size = 0;
+            for (long long lim = limit; ; lim *= 2) {
+                long long rest = 0;
+                if (_read(buff, m_fpos, lim, rest, skip) == false) {
+                    m_error = FILE_ERROR;
+                    return ret;
                 }
 
-                fread(&m_buff[0], 1, m_buff.size(), fp);
-                fclose(fp);
+                if (m_cnodes.size() == 0) {
+                    // wait until the header type can be detected
+                    if (buff.size() == 0 || (buff.size() < SPIO_BIN_MAGIC_SIZE && buff[0] == SPIO_BIN_MAGIC[0])) {
+                        if (rest > 0) continue;
+                        if (buff.size() > 0 && partial == false) {
+                            m_error = SIZE_ERROR;
+                            m_epos = 0;
+                            return ret;
+                        }
+                        return true;
+                    }
+                    m_header = _isBin(buff) ? BIN_HEADER : TXT_HEADER;
+                    m_cnodes.push_back(Node());
+                }
+
+                begin = skip + ((m_fpos == 0 && m_header == BIN_HEADER) ? SPIO_BIN_MAGIC_SIZE : 0);
+                if (_check(buff, begin, m_fpos - skip, partial, size) != NON_ERROR) return ret;
+
+                if (size > skip || rest == 0) break;
             }
+            if (size == skip) return true;
 
+            buff.resize(size);
             if (m_buff.size() > 0) {
-                ret = _parse();
+                m_buffs.push_back(std::vector<unsigned char>());
+                m_buffs.back().swap(m_buff);
             }
+            m_buff.swap(buff);
+
+            ret = _parse(begin);
+            m_fpos += size - skip;
 
             return ret;
         }
 
+        // drop parsed nodes and buffers, keeping the read position
+        // (refresh(limit) and release() walk through a file in bounded memory)
+        void release() {
+            std::vector<unsigned char>().swap(m_buff);
+            m_buffs.clear();
+
+            if (m_cnodes.size() > 0) {
+                m_cnodes.resize(1);
+                m_cnodes[0].m_cnodes.clear();
+            }
+        }
+
         //--------------------------------------------------------------------------------
         // util
         //--------------------------------------------------------------------------------
@@ -530,8 +1462,33 @@ namespace spio {
             return (m_cnodes.size() > 0) ? &m_cnodes[0] : NULL;
         }
 
+        const HEADER_TYPE& header() const {
+            return m_header;
+        }
+
+        // parsed file size
+        long long fpos() const {
+            return m_fpos;
+        }
+
+        // error of the last parse/refresh
+        const ERROR_CODE& error() const {
+            return m_error;
+        }
+
+        // file offset of the node where the error was found (-1: none)
+        long long errpos() const {
+            return m_epos;
+        }
+
         void print() {
-            for (int i = 0; i < m_buff.size(); i++) {
+            for (int b = 0; b < (int)m_buffs.size(); b++) {
+                for (size_t i = 0; i < m_buffs[b].size(); i++) {
+                    const char *c = (const char *)&m_buffs[b][i];
+                    SPIO_PRINTF("%c", *c);
+                }
+            }
+            for (size_t i = 0; i < m_buff.size(); i++) {
                 const char *c = (const char *)&m_buff[i];
                 SPIO_PRINTF("%c", *c);
             }
@@ -543,114 +1500,57 @@ namespace spio {
         // internal
         //--------------------------------------------------------------------------------
 
-        unsigned char& _getv(const int i) {
-            if (i < m_buff.size()) {
-                return m_buff[i];
-            }
-            else {
-                throw "spio:format error\n";
+        // read file bytes from offset (at most limit bytes if limit > 0, rest = bytes left behind)
+        // into buff after skip leading bytes
+        bool _read(std::vector<unsigned char> &buff, const long long offset, const long long limit, long long &rest, const long long skip = 0) {
+            bool ret = false;
+
+            FILE *fp = fopen(m_path.c_str(), "rb");
+            if (fp != NULL) {
+                {
+                    long long size = 0;
+                    SPIO_FSEEK(fp, 0, SEEK_END);
+                    size = (long long)SPIO_FTELL(fp);
+                    SPIO_FSEEK(fp, offset, SEEK_SET);
+
+                    long long len = (size > offset) ? size - offset : 0;
+                    rest = (limit > 0 && len > limit) ? len - limit : 0;
+
+                    buff.resize((size_t)(skip + len - rest));
+                }
+
+                if ((long long)buff.size() > skip) {
+                    buff.resize((size_t)(skip + fread(&buff[skip], 1, buff.size() - skip, fp)));
+                }
+                fclose(fp);
+                ret = true;
             }
+            return ret;
         }
 
-        bool _parse() {
+        // tokenize m_buff (validated by _check) and attach the nodes to root
+        bool _parse(const long long begin) {
             std::vector<int> indent;
             indent.push_back(-1);
 
-            m_cnodes.clear();
-            m_cnodes.push_back(Node());
-
-            try {
-                for (int i = 0; i < (int)m_buff.size();) {
-                    Node node;
-
-                    int pos = i;
-                    {
-                        for (; ; pos++) {
-                            if (_getv(pos) == '(' || _getv(pos) == '{' || _getv(pos) == '[') break;
-                        }
-                        indent.push_back(pos - i);
-
-                        switch (_getv(pos))
-                        {
-                        case '(': node.m_type = TXT_NODE; break;
-                        case '{': node.m_type = BIN_NODE; break;
-                        case '[': node.m_type = OBJ_NODE; break;
-                        default: break;
-                        }
-                        pos++;
-                    }
-
-                    {
-                        for (; ; pos++) {
-                            if (_getv(pos) == ')' || _getv(pos) == '}' || _getv(pos) == ']') break;
-                            node.m_name.push_back((char)_getv(pos));
-                        }
-                        pos++;
-                    }
-                    {
-                        const int spos = pos;
-
-                        switch (node.m_type) {
-                        case TXT_NODE:
-                        {
-                            // data step
-                            for (; ; pos++) {
-                                if (_getv(pos) == '\n') break;
-                            }
-                            pos++;
-
-                            node.m_size = pos - spos - 1;
-                            node.m_ptr = &_getv(spos);
-                            break;
-                        }
-                        case BIN_NODE:
-                        {
-                            // size step
-                            for (; ; pos++) {
-                                if (_getv(pos) == ',') break;
-                            }
-                            pos++;
-
-                            node.m_ptr = &_getv(pos);
-                            node.m_size = atoi(std::string(&_getv(spos), &_getv(pos - 1)).c_str());
-
-                            // data step
-                            pos += node.m_size + 1;
-                            break;
-                        }
-                        case OBJ_NODE:
-                        {
-                            // size step
-                            for (; ; pos++) {
-                                if (_getv(pos) == '\n') break;
-                            }
-                            pos++;
-
-                            node.m_ptr = &_getv(pos);
-                            node.m_size = atoi(std::string(&_getv(spos), &_getv(pos - 1)).c_str());
-                            break;
-                        }
-                        }
-                    }
+            const long long base = (long long)m_cnodes.size();
 
-                    m_cnodes.push_back(node);
-                    i += (pos - i);
-                }
+            if (m_header == BIN_HEADER) {
+                _parseBin(indent, begin);
             }
-            catch (char *str) {
-                SPIO_PRINTF(str);
-                throw str;
+            else {
+                _parseTxt(indent, begin);
             }
 
             std::vector<Node*> ptrs;
-            for (int i = 1; i < (int)m_cnodes.size(); i++) {
+            for (long long i = base; i < (long long)m_cnodes.size(); i++) {
                 Node &node = m_cnodes[i];
 
-                const int crnt = indent[i];
-                const int prev = indent[i - 1];
+                const int crnt = indent[i - base + 1];
+                const int prev = indent[i - base];
                 if (crnt > prev) {
                     {
-                        ptrs.push_back(&m_cnodes[i - 1]);
+                        ptrs.push_back((i == base) ? &m_cnodes[0] : &m_cnodes[i - 1]);
                     }
                 }
                 else if (crnt < prev) {
@@ -666,7 +1566,513 @@ namespace spio {
             return true;
         }
 
+        bool _isBin(const std::vector<unsigned char> &buff) {
+            return buff.size() >= SPIO_BIN_MAGIC_SIZE && memcmp(&buff[0], SPIO_BIN_MAGIC, SPIO_BIN_MAGIC_SIZE) == 0;
+        }
+
+
+        //--------------------------------------------------------------------------------
+        // validation
+        //--------------------------------------------------------------------------------
+
+        // check every header, size and nesting level in buff[begin, end) once
+        // base: file offset of buff[0], size: end of the leading complete top-level nodes
+        // partial: a truncated trailing node is not an error (refresh of a growing file)
+        ERROR_CODE _check(const std::vector<unsigned char> &buff, const long long begin, const long long base, const bool partial, long long &size) {
+            const long long end = (long long)buff.size();
+
+            // content ends of the open objects
+            std::vector<long long> ends;
+
+            // names defined so far (binary header)
+            long long names = (long long)m_names.size();
+
+            size = begin;
+
+            ERROR_CODE ret = NON_ERROR;
+            long long top = begin;
+            for (long long pos = begin; pos < end;) {
+                const long long spos = pos;
+                if (ends.size() == 0) top = spos;
+
+                int depth = -1;
+                long long next = -1;
+                ret = (m_header == BIN_HEADER) ? _checkBin(buff, pos, names, depth, next) : _checkTxt(buff, pos, depth, next);
+
+                if (ret == NON_ERROR && depth >= 0 && depth != (int)ends.size()) {
+                    ret = NEST_ERROR;
+                }
+                if (ret != NON_ERROR) {
+                    if (ret == SIZE_ERROR && partial == true) {
+                        ret = NON_ERROR;
+                        break;
+                    }
+                    m_epos = base + ((ret == SIZE_ERROR) ? top : spos);
+                    break;
+                }
+
+                if (next > pos) {
+                    // object content follows its header
+                    ends.push_back(next);
+                }
+
+                while (ends.size() > 0 && pos >= ends.back()) {
+                    if (pos > ends.back()) {
+                        ret = NEST_ERROR;
+                        m_epos = base + spos;
+                        break;
+                    }
+                    ends.pop_back();
+                }
+                if (ret != NON_ERROR) break;
+
+                if (ends.size() == 0) size = pos;
+            }
+
+            if (ret == NON_ERROR && ends.size() > 0 && partial == false) {
+                ret = SIZE_ERROR;
+                m_epos = base + top;
+            }
+
+            if (ret != NON_ERROR) {
+                SPIO_PRINTF("spio:format error (%d) at %lld\n", (int)ret, m_epos);
+            }
+            m_error = ret;
+            return ret;
+        }
+
+        // text header: pos is moved to the end of the node (past the header for objects, next = end of the content)
+        ERROR_CODE _checkTxt(const std::vector<unsigned char> &buff, long long &pos, int &depth, long long &next) {
+            const long long end = (long long)buff.size();
+            const long long spos = pos;
+
+            while (pos < end && buff[pos] == ' ') pos++;
+            if (pos >= end) return SIZE_ERROR;
+
+            depth = (int)(pos - spos);
+
+            unsigned char close = 0;
+            switch (buff[pos]) {
+            case '(': close = ')'; break;
+            case '{': close = '}'; break;
+            case '[': close = ']'; break;
+            case '<': close = '>'; break;
+            default: return FORMAT_ERROR;
+            }
+            const unsigned char open = buff[pos++];
+
+            for (; ; pos++) {
+                if (pos >= end) return SIZE_ERROR;
+                if (buff[pos] == ')' || buff[pos] == '}' || buff[pos] == ']' || buff[pos] == '>') break;
+                if (buff[pos] == '\n') return FORMAT_ERROR;
+            }
+            if (buff[pos++] != close) return FORMAT_ERROR;
+
+            long long dsize = 0;
+            switch (open) {
+            case '(':
+            {
+                for (; ; pos++) {
+                    if (pos >= end) return SIZE_ERROR;
+                    if (buff[pos] == '\n') break;
+                }
+                pos++;
+                break;
+            }
+            case '{':
+            {
+                const ERROR_CODE ret = _checkNum(buff, pos, ',', dsize);
+                if (ret != NON_ERROR) return ret;
+
+                if (dsize + 1 > end - pos) return SIZE_ERROR;
+                pos += dsize + 1;
+                if (buff[pos - 1] != '\n') return FORMAT_ERROR;
+                break;
+            }
+            case '[':
+            {
+                // blank size field: object still open in a stream writer
+                long long p = pos;
+                while (p < end && buff[p] == ' ') p++;
+                if (p >= end || buff[p] == '\n') return SIZE_ERROR;
+
+                const ERROR_CODE ret = _checkNum(buff, pos, '\n', dsize);
+                if (ret != NON_ERROR) return ret;
+
+                next = pos + dsize;
+                break;
+            }
+            case '<':
+            {
+                const ERROR_CODE ret = _checkNum(buff, pos, ',', dsize);
+                if (ret != NON_ERROR) return ret;
+
+                long long rows = 0;
+                {
+                    // rows is followed by ',' or '\n'
+                    long long p = pos;
+                    for (; p < end && buff[p] != ',' && buff[p] != '\n'; p++);
+                    if (p >= end) return SIZE_ERROR;
+
+                    const unsigned char term = buff[p];
+                    const ERROR_CODE ret = _checkNum(buff, pos, term, rows);
+                    if (ret != NON_ERROR) return ret;
+
+                    // name:elm,...
+                    long long offset = 0;
+                    for (bool last = (term == '\n'); last == false;) {
+                        long long q = pos;
+                        for (; q < end && buff[q] != ',' && buff[q] != '\n'; q++);
+                        if (q >= end) return SIZE_ERROR;
+                        last = (buff[q] == '\n');
+
+                        // the element size follows the last ':'
+                        long long c = q - 1;
+                        for (; c >= pos && buff[c] != ':'; c--);
+                        if (c < pos) return FORMAT_ERROR;
+                        pos = c + 1;
+
+                        long long elm = 0;
+                        const ERROR_CODE ret = _checkNum(buff, pos, buff[q], elm);
+                        if (ret != NON_ERROR) return ret;
+                        if (elm > 0x7FFFFFFF || (elm > 0 && rows > dsize / elm)) return FORMAT_ERROR;
+
+                        offset = (offset + SPIO_TBL_ALIGN - 1) / SPIO_TBL_ALIGN * SPIO_TBL_ALIGN + rows * elm;
+                    }
+                    if (offset > dsize) return FORMAT_ERROR;
+                }
+
+                if (dsize + 1 > end - pos) return SIZE_ERROR;
+                pos += dsize + 1;
+                if (buff[pos - 1] != '\n') return FORMAT_ERROR;
+                break;
+            }
+            }
+            return NON_ERROR;
+        }
+
+        // binary header: pos is moved to the end of the record (past the header for objects, next = end of the content)
+        ERROR_CODE _checkBin(const std::vector<unsigned char> &buff, long long &pos, long long &names, int &depth, long long &next) {
+            const long long end = (long long)buff.size();
+
+            ERROR_CODE ret = NON_ERROR;
+
+            const unsigned char kind = buff[pos++];
+            switch (kind) {
+            case SPIO_BIN_NAMES:
+            {
+                long long num = 0;
+                if ((ret = _checkVar(buff, pos, num)) != NON_ERROR) return ret;
+
+                for (long long n = 0; n < num; n++) {
+                    long long len = 0;
+                    if ((ret = _checkVar(buff, pos, len)) != NON_ERROR) return ret;
+                    if (len > end - pos) return SIZE_ERROR;
+                    pos += len;
+                }
+                names += num;
+                return ret;
+            }
+            case SPIO_BIN_PAD:
+            {
+                long long num = 0;
+                if ((ret = _checkVar(buff, pos, num)) != NON_ERROR) return ret;
+                if (num > end - pos) return SIZE_ERROR;
+
+                pos += num;
+                return ret;
+            }
+            case TXT_NODE:
+            case BIN_NODE:
+            case OBJ_NODE:
+            case TBL_NODE:
+                break;
+            default:
+                return FORMAT_ERROR;
+            }
+
+            long long id = 0, dep = 0, dsize = 0;
+            if ((ret = _checkVar(buff, pos, id)) != NON_ERROR) return ret;
+            if (id >= names) return FORMAT_ERROR;
+
+            if ((ret = _checkVar(buff, pos, dep)) != NON_ERROR) return ret;
+            if (dep > 0x7FFFFFFF) return NEST_ERROR;
+            depth = (int)dep;
+
+            if ((ret = _checkVar(buff, pos, dsize)) != NON_ERROR) return ret;
+
+            if (kind == TBL_NODE) {
+                long long rows = 0, cols = 0;
+                if ((ret = _checkVar(buff, pos, rows)) != NON_ERROR) return ret;
+                if ((ret = _checkVar(buff, pos, cols)) != NON_ERROR) return ret;
+
+                long long offset = 0;
+                for (long long c = 0; c < cols; c++) {
+                    long long cid = 0, elm = 0;
+                    if ((ret = _checkVar(buff, pos, cid)) != NON_ERROR) return ret;
+                    if (cid >= names) return FORMAT_ERROR;
+
+                    if ((ret = _checkVar(buff, pos, elm)) != NON_ERROR) return ret;
+                    if (elm > 0x7FFFFFFF || (elm > 0 && rows > dsize / elm)) return FORMAT_ERROR;
+
+                    offset = (offset + SPIO_TBL_ALIGN - 1) / SPIO_TBL_ALIGN * SPIO_TBL_ALIGN + rows * elm;
+                    if (offset > dsize) return FORMAT_ERROR;
+                }
+            }
+
+            if (kind == OBJ_NODE) {
+                // zero filled size field: object still open in a stream writer
+                if (dsize == 0 && pos < end && buff[pos] == 0) return SIZE_ERROR;
+
+                next = pos + dsize;
+            }
+            else {
+                if (dsize > end - pos) return SIZE_ERROR;
+                pos += dsize;
+            }
+            return ret;
+        }
+
+        // decimal number (leading spaces allowed) terminated by term
+        ERROR_CODE _checkNum(const std::vector<unsigned char> &buff, long long &pos, const unsigned char term, long long &val) {
+            const long long end = (long long)buff.size();
+
+            while (pos < end && buff[pos] == ' ') pos++;
+
+            val = 0;
+            int digits = 0;
+            for (; ; pos++) {
+                if (pos >= end) return SIZE_ERROR;
+                if (buff[pos] == term) break;
+                if (buff[pos] < '0' || buff[pos] > '9' || digits >= 18) return FORMAT_ERROR;
+
+                val = val * 10 + (buff[pos] - '0');
+                digits++;
+            }
+            if (digits == 0) return FORMAT_ERROR;
+
+            pos++;
+            return NON_ERROR;
+        }
+
+        // LEB128 varint (at most 10 bytes, below 2^63)
+        ERROR_CODE _checkVar(const std::vector<unsigned char> &buff, long long &pos, long long &val) {
+            const long long end = (long long)buff.size();
+
+            unsigned long long v = 0;
+            for (int s = 0; ; s += 7) {
+                if (pos >= end) return SIZE_ERROR;
+                if (s > 63) return FORMAT_ERROR;
+
+                const unsigned char c = buff[pos++];
+                v |= (unsigned long long)(c & 0x7F) << s;
+                if ((c & 0x80) == 0) break;
+            }
+            if (v > 0x7FFFFFFFFFFFFFFFULL) return FORMAT_ERROR;
+
+            val = (long long)v;
+            return NON_ERROR;
+        }
+
+
+        //--------------------------------------------------------------------------------
+        // tokenize (no bounds checks, the buffer is validated by _check)
+        //--------------------------------------------------------------------------------
+
+        // text header: indent, bracketed name, text size
+        void _parseTxt(std::vector<int> &indent, const long long begin) {
+            const unsigned char *buff = &m_buff[0];
+            const long long end = (long long)m_buff.size();
+
+            for (long long pos = begin; pos < end;) {
+                Node node;
+                {
+                    const long long spos = pos;
+                    while (buff[pos] == ' ') pos++;
+                    indent.push_back((int)(pos - spos));
+
+                    switch (buff[pos]) {
+                    case '(': node.m_type = TXT_NODE; break;
+                    case '{': node.m_type = BIN_NODE; break;
+                    case '[': node.m_type = OBJ_NODE; break;
+                    case '<': node.m_type = TBL_NODE; break;
+                    default: break;
+                    }
+                    pos++;
+                }
+                {
+                    const long long spos = pos;
+                    while (buff[pos] != ')' && buff[pos] != '}' && buff[pos] != ']' && buff[pos] != '>') pos++;
+
+                    node.m_name.assign((const char*)&buff[spos], (size_t)(pos - spos));
+                    pos++;
+                }
+                {
+                    const long long spos = pos;
+
+                    switch (node.m_type) {
+                    case TXT_NODE:
+                    {
+                        // data step
+                        while (buff[pos] != '\n') pos++;
+
+                        node.m_ptr = (void*)&buff[spos];
+                        node.m_size = pos - spos;
+                        pos++;
+                        break;
+                    }
+                    case BIN_NODE:
+                    {
+                        // size step
+                        node.m_size = _getNum(buff, pos);
+                        node.m_ptr = (void*)&buff[pos];
+
+                        // data step
+                        pos += node.m_size + 1;
+                        break;
+                    }
+                    case OBJ_NODE:
+                    {
+                        // size step (children follow)
+                        node.m_size = _getNum(buff, pos);
+                        node.m_ptr = (void*)(buff + pos);
+                        break;
+                    }
+                    case TBL_NODE:
+                    {
+                        // schema step
+                        while (buff[pos] != '\n') pos++;
+                        pos++;
+
+                        // size,rows,name:elm,name:elm,...
+                        const std::vector<std::string> list = node._divTxt(&buff[spos], pos - spos - 1);
+
+                        node.m_size = atoll(list[0].c_str());
+                        node.m_rows = atoll(list[1].c_str());
+
+                        long long offset = 0;
+                        for (int c = 2; c < (int)list.size(); c++) {
+                            const size_t p = list[c].find_last_of(':');
+
+                            const int elm = atoi(list[c].c_str() + p + 1);
+                            offset = (offset + SPIO_TBL_ALIGN - 1) / SPIO_TBL_ALIGN * SPIO_TBL_ALIGN;
+
+                            node.m_cnames.push_back(list[c].substr(0, p));
+                            node.m_celms.push_back(elm);
+                            node.m_coffs.push_back(offset);
+                            offset += node.m_rows * elm;
+                        }
+
+                        // data step
+                        node.m_ptr = (void*)&buff[pos];
+                        pos += node.m_size + 1;
+                        break;
+                    }
+                    default: break;
+                    }
+                }
+
+                m_cnodes.push_back(node);
+            }
+        }
+
+        // binary header: type, name id, depth, varint size
+        void _parseBin(std::vector<int> &indent, const long long begin) {
+            const unsigned char *buff = &m_buff[0];
+            const long long end = (long long)m_buff.size();
+
+            for (long long pos = begin; pos < end;) {
+                const unsigned char kind = buff[pos++];
+
+                if (kind == SPIO_BIN_NAMES) {
+                    const long long num = _getVar(buff, pos);
+                    for (long long n = 0; n < num; n++) {
+                        const long long len = _getVar(buff, pos);
+                        m_names.push_back(std::string((const char*)buff + pos, (size_t)len));
+                        pos += len;
+                    }
+                    continue;
+                }
+                if (kind == SPIO_BIN_PAD) {
+                    pos += _getVar(buff, pos);
+                    continue;
+                }
+
+                Node node;
+                node.m_type = (NODE_TYPE)kind;
+                node.m_name = m_names[(size_t)_getVar(buff, pos)];
+
+                indent.push_back((int)_getVar(buff, pos));
+
+                node.m_size = _getVar(buff, pos);
+
+                if (node.m_type == TBL_NODE) {
+                    node.m_rows = _getVar(buff, pos);
+
+                    const long long cols = _getVar(buff, pos);
+
+                    long long offset = 0;
+                    for (long long c = 0; c < cols; c++) {
+                        const long long cid = _getVar(buff, pos);
+                        const int elm = (int)_getVar(buff, pos);
+                        offset = (offset + SPIO_TBL_ALIGN - 1) / SPIO_TBL_ALIGN * SPIO_TBL_ALIGN;
+
+                        node.m_cnames.push_back(m_names[(size_t)cid]);
+                        node.m_celms.push_back(elm);
+                        node.m_coffs.push_back(offset);
+                        offset += node.m_rows * elm;
+                    }
+                }
+
+                node.m_ptr = (void*)(buff + pos);
+
+                // object children follow as records
+                if (node.m_type != OBJ_NODE) {
+                    pos += node.m_size;
+                }
+
+                m_cnodes.push_back(node);
+            }
+        }
+
+        long long _getNum(const unsigned char *buff, long long &pos) {
+            while (buff[pos] == ' ') pos++;
+
+            long long val = 0;
+            for (; buff[pos] >= '0' && buff[pos] <= '9'; pos++) {
+                val = val * 10 + (buff[pos] - '0');
+            }
+            pos++;
+            return val;
+        }
+
+        long long _getVar(const unsigned char *buff, long long &pos) {
+            unsigned long long val = 0;
+            for (int s = 0; ; s += 7) {
+                const unsigned char c = buff[pos++];
+                val |= (unsigned long long)(c & 0x7F) << s;
+                if ((c & 0x80) == 0) break;
+            }
+            return (long long)val;
+        }
+
     };
+
+
+    //--------------------------------------------------------------------------------
+    // convert (text header <-> binary header)
+    //--------------------------------------------------------------------------------
+    // false when src does not parse or has names or text a text header cannot represent (dst is then not written)
+    // false when src does not parse or holds names or text that the text header cannot (dst is not written)
+    SPIO_FUNC inline bool convert(const std::string &src, const std::string &dst, const HEADER_TYPE header) {
+        Reader reader(src);
+        if (reader.parse() == false) return false;
+
+        Writer writer(dst, header);
+        writer.addNode(reader.root());
+
+        return writer.flush();
+    }
 }
 
 #ifdef _WIN32
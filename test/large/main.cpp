@@ -0,0 +1,151 @@
+﻿#include "spio.h"
+
+//--------------------------------------------------------------------------------
+// files and a single binary node over 4 GB (32-bit sizes and offsets overflow)
+//--------------------------------------------------------------------------------
+
+static const long long GB = 1LL << 30;
+
+// sample offsets around the 32-bit boundary
+static const long long OFFSETS[] = { 0, (1LL << 31), (1LL << 32) - 1, (1LL << 32), (1LL << 32) + 1 };
+
+static unsigned char sample(const long long offset) {
+    return (unsigned char)(offset % 251 + 1);
+}
+
+static long long fileSize(const std::string &path) {
+    long long ret = -1;
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (fp != NULL) {
+        SPIO_FSEEK(fp, 0, SEEK_END);
+        ret = (long long)SPIO_FTELL(fp);
+        fclose(fp);
+    }
+    return ret;
+}
+
+#define CHECK(COND) if (!(COND)) { printf("failed: %s (line %d)\n", #COND, __LINE__); return false; }
+
+// single BIN node of size bytes inside an object
+static bool testNode(const spio::HEADER_TYPE header, const long long size) {
+    const std::string path = "test_large_node.sp";
+    {
+        // untouched pages of a calloc buffer stay unallocated
+        unsigned char *data = (unsigned char*)calloc((size_t)size, 1);
+        CHECK(data != NULL);
+
+        const int num = (int)(sizeof(OFFSETS) / sizeof(OFFSETS[0]));
+        for (int i = 0; i < num; i++) {
+            data[OFFSETS[i]] = sample(OFFSETS[i]);
+        }
+        data[size - 1] = sample(size - 1);
+
+        spio::Writer writer;
+        CHECK(writer.open(path, header));
+        {
+            SPIO_NEST(writer, "obj");
+            writer.addBin("big", data, size);
+            writer.addTxt("tail", "end");
+        }
+        CHECK(writer.close());
+        free(data);
+    }
+    CHECK(fileSize(path) > size);
+    {
+        spio::Reader reader(path);
+        CHECK(reader.parse());
+
+        const spio::Node *obj = reader.root()->getCNode("obj");
+        CHECK(obj != NULL && obj->size() > size);
+
+        const spio::Node *big = obj->getCNode("big");
+        CHECK(big != NULL && big->size() == size);
+
+        const unsigned char *data = (const unsigned char*)big->ptr();
+        const int num = (int)(sizeof(OFFSETS) / sizeof(OFFSETS[0]));
+        for (int i = 0; i < num; i++) {
+            CHECK(data[OFFSETS[i]] == sample(OFFSETS[i]));
+        }
+        CHECK(data[size - 1] == sample(size - 1));
+        CHECK(data[1] == 0 && data[size - 2] == 0);
+
+        std::string tail;
+        CHECK(obj->getCNode("tail") != NULL && obj->getCNode("tail")->cnvTxt(tail) && tail == "end");
+    }
+    remove(path.c_str());
+    return true;
+}
+
+// file of top-level nodes of size bytes, read back in batches
+static bool testFile(const spio::HEADER_TYPE header, const int nodes, const long long size) {
+    const std::string path = "test_large_file.sp";
+    {
+        unsigned char *data = (unsigned char*)calloc((size_t)size, 1);
+        CHECK(data != NULL);
+
+        spio::Writer writer;
+        CHECK(writer.open(path, header));
+        for (int i = 0; i < nodes; i++) {
+            data[0] = sample(i);
+            data[size - 1] = sample(i + 1);
+            writer.addBin("node", data, size);
+        }
+        writer.addTxt("tail", "%d", nodes);
+        CHECK(writer.close());
+        free(data);
+    }
+
+    const long long fsize = fileSize(path);
+    CHECK(fsize > (long long)nodes * size);
+    {
+        spio::Reader reader(path);
+
+        int count = 0;
+        bool tail = false;
+        while (true) {
+            const long long fpos = reader.fpos();
+            CHECK(reader.refresh(2 * size));
+            if (reader.fpos() == fpos) break;
+
+            const std::vector<const spio::Node*> list = reader.root()->getCNodes();
+            for (int i = 0; i < (int)list.size(); i++) {
+                const spio::Node *node = list[i];
+                if (node->name() == "node") {
+                    CHECK(node->size() == size);
+
+                    const unsigned char *data = (const unsigned char*)node->ptr();
+                    CHECK(data[0] == sample(count) && data[size - 1] == sample(count + 1));
+                    count++;
+                }
+                if (node->name() == "tail") {
+                    std::string text;
+                    CHECK(node->cnvTxt(text) && atoi(text.c_str()) == nodes);
+                    tail = true;
+                }
+            }
+            reader.release();
+        }
+        CHECK(count == nodes && tail);
+        CHECK(reader.fpos() == fsize);
+    }
+    remove(path.c_str());
+    return true;
+}
+
+int main(){
+
+    const spio::HEADER_TYPE headers[] = { spio::TXT_HEADER, spio::BIN_HEADER };
+
+    for (int h = 0; h < 2; h++) {
+        const char *name = (headers[h] == spio::BIN_HEADER) ? "binary" : "text";
+
+        // 4.25 GB file of 64 MB nodes
+        if (testFile(headers[h], 68, 64LL << 20) == false) return 1;
+        printf("%s: file over 4 GB ok\n", name);
+
+        // 4.25 GB node
+        if (testNode(headers[h], 4 * GB + GB / 4) == false) return 1;
+        printf("%s: node over 4 GB ok\n", name);
+    }
+    return 0;
+}
\ No newline at end of file
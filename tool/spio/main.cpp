@@ -0,0 +1,388 @@
+﻿#include "spio.h"
+
+#include <algorithm>
+
+//--------------------------------------------------------------------------------
+// spio stat <file> [-batch MB]
+// spio repack <src> <dst> [-txt | -bin] [-align N] [-sort] [-dedup] [-batch MB]
+//
+// both commands stream through the file by top-level nodes (Reader::refresh + release),
+// so memory is bounded by the batch size or the largest top-level node
+// (repack also holds the output of one batch).
+//--------------------------------------------------------------------------------
+
+struct Option {
+    // output header type (-1: same as the source)
+    int header;
+
+    // payload alignment of BIN nodes (TBL nodes are aligned to SPIO_TBL_ALIGN at least)
+    int align;
+
+    // reorder children by name (stable, order within a name is kept)
+    bool sort;
+
+    // drop children identical to an earlier sibling
+    bool dedup;
+
+    // read batch size [bytes]
+    long long batch;
+
+    Option() {
+        header = -1;
+        align = SPIO_TBL_ALIGN;
+        sort = false;
+        dedup = false;
+        batch = 64LL << 20;
+    }
+};
+
+
+//--------------------------------------------------------------------------------
+// stat
+//--------------------------------------------------------------------------------
+
+struct Stat {
+    spio::NODE_TYPE type;
+
+    // number of nodes with this path
+    long long count;
+
+    // number of nodes in the subtrees
+    long long nodes;
+
+    // data bytes in the subtrees (text, binary and table payloads)
+    long long bytes;
+
+    Stat() {
+        type = spio::NON_NODE;
+        count = 0;
+        nodes = 0;
+        bytes = 0;
+    }
+};
+
+static const char* typeName(const spio::NODE_TYPE type) {
+    switch (type) {
+    case spio::TXT_NODE: return "txt";
+    case spio::BIN_NODE: return "bin";
+    case spio::OBJ_NODE: return "obj";
+    case spio::TBL_NODE: return "tbl";
+    default: return "-";
+    }
+}
+
+static void addStat(std::map<std::string, Stat> &stats, const std::string &path, const spio::Node *node, long long &nodes, long long &bytes) {
+    const std::string crnt = path + "/" + node->name();
+
+    nodes = 1;
+    bytes = (node->type() == spio::OBJ_NODE) ? 0 : node->size();
+
+    const std::vector<const spio::Node*> list = node->getCNodes();
+    for (int i = 0; i < (int)list.size(); i++) {
+        long long n, b;
+        addStat(stats, crnt, list[i], n, b);
+        nodes += n;
+        bytes += b;
+    }
+
+    Stat &stat = stats[crnt];
+    stat.type = node->type();
+    stat.count++;
+    stat.nodes += nodes;
+    stat.bytes += bytes;
+}
+
+static int readError(const spio::Reader &reader, const std::string &path) {
+    if (reader.error() == spio::FILE_ERROR) {
+        printf("spio: could not read %s\n", path.c_str());
+    }
+    else {
+        printf("spio: format error %d at %lld in %s\n", (int)reader.error(), reader.errpos(), path.c_str());
+    }
+    return 1;
+}
+
+static int runStat(const std::string &path, const Option &opt) {
+    std::map<std::string, Stat> stats;
+
+    spio::Reader reader(path);
+
+    long long nodes = 0;
+    long long bytes = 0;
+    while (true) {
+        const long long fpos = reader.fpos();
+        if (reader.refresh(opt.batch) == false) {
+            return readError(reader, path);
+        }
+        if (reader.fpos() == fpos) {
+            // bytes left behind a partial refresh are a truncated node
+            if (reader.refresh(-1, false) == false) {
+                return readError(reader, path);
+            }
+            break;
+        }
+
+        const std::vector<const spio::Node*> list = reader.root()->getCNodes();
+        for (int i = 0; i < (int)list.size(); i++) {
+            long long n, b;
+            addStat(stats, "", list[i], n, b);
+            nodes += n;
+            bytes += b;
+        }
+        reader.release();
+    }
+
+    printf("%-40s %4s %12s %12s %16s\n", "path", "type", "count", "nodes", "bytes");
+    for (std::map<std::string, Stat>::iterator it = stats.begin(); it != stats.end(); it++) {
+        const Stat &stat = it->second;
+        printf("%-40s %4s %12lld %12lld %16lld\n", it->first.c_str(), typeName(stat.type), stat.count, stat.nodes, stat.bytes);
+    }
+    printf("\n");
+    printf("header  : %s\n", (reader.header() == spio::BIN_HEADER) ? "binary" : "text");
+    printf("file    : %lld bytes\n", reader.fpos());
+    printf("nodes   : %lld\n", nodes);
+    printf("data    : %lld bytes\n", bytes);
+    printf("headers : %lld bytes\n", reader.fpos() - bytes);
+    return 0;
+}
+
+
+//--------------------------------------------------------------------------------
+// repack
+//--------------------------------------------------------------------------------
+
+static unsigned long long hashNode(const spio::Node *node) {
+    // FNV-1a
+    unsigned long long ret = 14695981039346656037ULL;
+    const unsigned long long prime = 1099511628211ULL;
+
+    ret = (ret ^ (unsigned long long)node->type()) * prime;
+    for (size_t i = 0; i < node->name().size(); i++) {
+        ret = (ret ^ (unsigned char)node->name()[i]) * prime;
+    }
+
+    if (node->type() == spio::OBJ_NODE) {
+        const std::vector<const spio::Node*> list = node->getCNodes();
+        for (int i = 0; i < (int)list.size(); i++) {
+            ret = (ret ^ hashNode(list[i])) * prime;
+        }
+    }
+    else {
+        if (node->type() == spio::TBL_NODE) {
+            for (int c = 0; c < node->cols(); c++) {
+                ret = (ret ^ (unsigned long long)node->colElm(c)) * prime;
+            }
+        }
+
+        const unsigned char *p = (const unsigned char*)node->ptr();
+        for (long long i = 0; i < node->size(); i++) {
+            ret = (ret ^ p[i]) * prime;
+        }
+    }
+    return ret;
+}
+
+static bool equalNode(const spio::Node *a, const spio::Node *b) {
+    if (a->type() != b->type() || a->name() != b->name()) return false;
+
+    if (a->type() == spio::OBJ_NODE) {
+        const std::vector<const spio::Node*> la = a->getCNodes();
+        const std::vector<const spio::Node*> lb = b->getCNodes();
+        if (la.size() != lb.size()) return false;
+
+        for (int i = 0; i < (int)la.size(); i++) {
+            if (equalNode(la[i], lb[i]) == false) return false;
+        }
+        return true;
+    }
+
+    if (a->type() == spio::TBL_NODE) {
+        if (a->elms() != b->elms() || a->cols() != b->cols()) return false;
+        for (int c = 0; c < a->cols(); c++) {
+            if (a->colName(c) != b->colName(c) || a->colElm(c) != b->colElm(c)) return false;
+        }
+    }
+    return a->size() == b->size() && memcmp(a->ptr(), b->ptr(), (size_t)a->size()) == 0;
+}
+
+static bool compareName(const spio::Node *a, const spio::Node *b) {
+    return a->name() < b->name();
+}
+
+static void emit(spio::Writer &writer, const spio::Node *node, const Option &opt) {
+    if (node->type() != spio::OBJ_NODE) {
+        writer.addNode(node);
+        return;
+    }
+
+    std::vector<const spio::Node*> list = node->getCNodes();
+    if (opt.sort) {
+        std::stable_sort(list.begin(), list.end(), compareName);
+    }
+    if (opt.dedup) {
+        std::multimap<unsigned long long, const spio::Node*> hashes;
+
+        std::vector<const spio::Node*> tmp;
+        for (int i = 0; i < (int)list.size(); i++) {
+            const unsigned long long hash = hashNode(list[i]);
+
+            bool found = false;
+            typedef std::multimap<unsigned long long, const spio::Node*>::iterator Iterator;
+            const std::pair<Iterator, Iterator> range = hashes.equal_range(hash);
+            for (Iterator it = range.first; it != range.second && found == false; it++) {
+                found = equalNode(it->second, list[i]);
+            }
+            if (found == false) {
+                hashes.insert(std::make_pair(hash, list[i]));
+                tmp.push_back(list[i]);
+            }
+        }
+        list = tmp;
+    }
+
+    writer.nest(node->name());
+    for (int i = 0; i < (int)list.size(); i++) {
+        emit(writer, list[i], opt);
+    }
+    writer.unnest();
+}
+
+static int writeError(const spio::Writer &writer, const std::string &src, const std::string &dst) {
+    if (writer.error() != spio::NON_ERROR) {
+        printf("spio: %s has names or text that a text header cannot hold\n", src.c_str());
+    }
+    else {
+        printf("spio: could not write %s\n", dst.c_str());
+    }
+    remove(dst.c_str());
+    return 1;
+}
+
+static int runRepack(const std::string &src, const std::string &dst, const Option &opt) {
+    // the writer truncates dst before src is read to the end
+    if (src == dst) {
+        printf("spio: %s is both source and destination\n", src.c_str());
+        return 1;
+    }
+
+    spio::Reader reader(src);
+
+    // each batch is laid out in memory and appended, so object sizes are written exactly
+    // (the stream writer would reserve fixed width size fields)
+    spio::Writer writer;
+
+    bool open = false;
+    while (true) {
+        const long long fpos = reader.fpos();
+        if (reader.refresh(opt.batch) == false) {
+            if (open) {
+                remove(dst.c_str());
+            }
+            return readError(reader, src);
+        }
+        if (reader.root() == NULL) break;
+
+        if (open == false) {
+            const spio::HEADER_TYPE header = (opt.header < 0) ? reader.header() : (spio::HEADER_TYPE)opt.header;
+
+            // start from an empty file (append writes the binary header magic)
+            FILE *fp = fopen(dst.c_str(), "wb");
+            if (fp == NULL) {
+                printf("spio: could not write %s\n", dst.c_str());
+                return 1;
+            }
+            fclose(fp);
+
+            writer.init(dst, header);
+            writer.setAlign(opt.align);
+            open = true;
+        }
+        if (reader.fpos() == fpos) {
+            // bytes left behind a partial refresh are a truncated node
+            if (reader.refresh(-1, false) == false) {
+                remove(dst.c_str());
+                return readError(reader, src);
+            }
+            break;
+        }
+
+        const std::vector<const spio::Node*> list = reader.root()->getCNodes();
+        for (int i = 0; i < (int)list.size(); i++) {
+            emit(writer, list[i], opt);
+        }
+        reader.release();
+
+        if (writer.append() == false) {
+            return writeError(writer, src, dst);
+        }
+    }
+
+    if (open == false) {
+        printf("spio: no data in %s\n", src.c_str());
+        return 1;
+    }
+    return 0;
+}
+
+
+//--------------------------------------------------------------------------------
+// main
+//--------------------------------------------------------------------------------
+
+static void usage() {
+    printf("usage:\n");
+    printf("  spio stat <file> [-batch MB]\n");
+    printf("  spio repack <src> <dst> [-txt | -bin] [-align N] [-sort] [-dedup] [-batch MB]\n");
+    printf("\n");
+    printf("  -txt, -bin : output header type (default: same as src)\n");
+    printf("  -align N   : align binary payloads to N bytes (default: %d, 0: off, tables are always aligned)\n", SPIO_TBL_ALIGN);
+    printf("  -sort      : reorder children of objects by name\n");
+    printf("  -dedup     : drop children identical to an earlier sibling\n");
+    printf("  -batch MB  : read batch size (default: 64)\n");
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+
+    const std::string cmd = argv[1];
+
+    std::vector<std::string> args;
+    Option opt;
+    for (int i = 2; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "-txt") {
+            opt.header = spio::TXT_HEADER;
+        }
+        else if (arg == "-bin") {
+            opt.header = spio::BIN_HEADER;
+        }
+        else if (arg == "-align" && i + 1 < argc) {
+            opt.align = atoi(argv[++i]);
+        }
+        else if (arg == "-sort") {
+            opt.sort = true;
+        }
+        else if (arg == "-dedup") {
+            opt.dedup = true;
+        }
+        else if (arg == "-batch" && i + 1 < argc) {
+            opt.batch = atoll(argv[++i]) << 20;
+        }
+        else {
+            args.push_back(arg);
+        }
+    }
+
+    if (cmd == "stat" && args.size() == 1) {
+        return runStat(args[0], opt);
+    }
+    if (cmd == "repack" && args.size() == 2) {
+        return runRepack(args[0], args[1], opt);
+    }
+
+    usage();
+    return 1;
+}